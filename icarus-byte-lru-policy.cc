@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include "icarus-byte-lru-policy.hpp"
+
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE("icarus.IcarusByteLruPolicy");
+
+namespace ns3 {
+namespace icarus {
+
+namespace {
+
+std::size_t
+getSize(nfd::cs::Policy::EntryRef i)
+{
+  return i->getData().wireEncode().size();
+}
+
+}
+
+IcarusByteLruPolicy::IcarusByteLruPolicy(std::size_t capacity)
+  : Policy("byte-lru")
+  , capacity(capacity)
+{
+  NS_LOG_FUNCTION(this << capacity);
+}
+
+void
+IcarusByteLruPolicy::doAfterInsert(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  const auto size = getSize(i);
+  positions[&*i] = {queue.insert(queue.end(), i), size};
+  bytes += size;
+
+  evictEntries();
+}
+
+void
+IcarusByteLruPolicy::doAfterRefresh(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  // The Data may have been replaced by one of a different size
+  remove(i);
+  doAfterInsert(i);
+}
+
+void
+IcarusByteLruPolicy::doBeforeErase(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  remove(i);
+}
+
+void
+IcarusByteLruPolicy::doBeforeUse(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  queue.splice(queue.end(), queue, positions.at(&*i).entry);
+}
+
+void
+IcarusByteLruPolicy::evictEntries()
+{
+  NS_LOG_FUNCTION(this);
+
+  while (!queue.empty() && (bytes > capacity || queue.size() > getLimit())) {
+    const auto i = queue.front();
+    remove(i);
+    this->emitSignal(beforeEvict, i);
+  }
+}
+
+void
+IcarusByteLruPolicy::remove(EntryRef i) noexcept
+{
+  const auto position = positions.find(&*i);
+  if (position == positions.end()) {
+    return;
+  }
+
+  bytes -= position->second.size;
+  queue.erase(position->second.entry);
+  positions.erase(position);
+}
+
+}
+}
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_BYTE_LRU_POLICY_HPP
+#define ICARUS_BYTE_LRU_POLICY_HPP
+
+#include "ns3/ndnSIM/NFD/daemon/table/cs-policy.hpp"
+
+#include <list>
+#include <unordered_map>
+
+namespace ns3 {
+namespace icarus {
+
+// LRU replacement policy bounded by the size of the stored Data packets. The
+// packet limit of the CS still applies.
+class IcarusByteLruPolicy : public nfd::cs::Policy {
+public:
+  explicit IcarusByteLruPolicy(std::size_t capacity);
+
+private:
+  void doAfterInsert(EntryRef i) override;
+  void doAfterRefresh(EntryRef i) override;
+  void doBeforeErase(EntryRef i) override;
+  void doBeforeUse(EntryRef i) override;
+  void evictEntries() override;
+
+  void remove(EntryRef i) noexcept;
+
+  const std::size_t capacity;
+  std::size_t bytes = 0;
+  std::list<EntryRef> queue; // Least recently used first
+  struct Position {
+    std::list<EntryRef>::iterator entry;
+    std::size_t size; // As accounted when inserted
+  };
+  std::unordered_map<const nfd::cs::Entry*, Position> positions;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include "icarus-checkpoint.hpp"
+#include "icarus-grid-helper.hpp"
+#include "icarus-grid-tracer.hpp"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("icarus.IcarusCheckpointer");
+
+namespace ns3 {
+namespace icarus {
+
+namespace {
+
+constexpr uint32_t magic = 0x504b4349; // "ICKP"
+constexpr uint32_t version = 3;
+
+}
+
+using checkpoint::read;
+using checkpoint::write;
+
+IcarusCheckpointer::IcarusCheckpointer(const IcarusGridHelper& grid,
+                                       const std::string& path) noexcept
+  : grid(grid)
+  , path(path)
+{
+  NS_LOG_FUNCTION(this << &grid << path);
+}
+
+Time
+IcarusCheckpointer::Load()
+{
+  NS_LOG_FUNCTION(this);
+
+  std::ifstream is(path, std::ios_base::binary);
+  NS_ABORT_MSG_UNLESS(is, "Cannot open checkpoint " << path);
+  is.exceptions(std::ios_base::failbit | std::ios_base::badbit | std::ios_base::eofbit);
+
+  NS_ABORT_MSG_UNLESS(read<uint32_t>(is) == magic && read<uint32_t>(is) == version,
+                      "Not a valid checkpoint: " << path);
+  offset = NanoSeconds(read<int64_t>(is));
+  NS_ABORT_MSG_UNLESS(read<uint64_t>(is) == grid.getRows()
+                        && read<uint64_t>(is) == grid.getColumns(),
+                      "Checkpoint taken with a different grid.");
+
+  tracerState.resize(read<uint64_t>(is));
+  is.read(tracerState.data(), tracerState.size());
+
+  checkpointed.resize(read<uint64_t>(is));
+  for (auto& consumer : checkpointed) {
+    consumer.start = NanoSeconds(read<int64_t>(is));
+    consumer.expected = read<uint64_t>(is);
+    // Every segment before the first missing one had been received
+    consumer.received.assign(read<uint64_t>(is), true);
+  }
+
+  for (auto row = 0u; row < grid.getRows(); row++) {
+    for (auto col = 0u; col < grid.getColumns(); col++) {
+      auto& cs = grid.GetNode(row, col)->GetObject<ndn::L3Protocol>()->getForwarder()->getCs();
+
+      for (auto entries = read<uint64_t>(is); entries > 0; entries--) {
+        auto wire = std::make_shared<::ndn::Buffer>(read<uint64_t>(is));
+        is.read(reinterpret_cast<char*>(wire->data()), wire->size());
+        cs.insert(*std::make_shared<::ndn::Data>(::ndn::Block(wire)));
+      }
+    }
+  }
+
+  NS_LOG_INFO("Resuming from " << offset.GetSeconds() << "s");
+
+  return offset;
+}
+
+std::optional<Time>
+IcarusCheckpointer::AddConsumer(Time start, std::size_t expected)
+{
+  NS_LOG_FUNCTION(this << start << expected);
+
+  const auto consumer = consumers.size();
+  consumers.push_back({start, expected, {}});
+
+  if (consumer >= checkpointed.size()) {
+    NS_ABORT_MSG_UNLESS(checkpointed.empty(), "More consumers than in the checkpointed run.");
+    return start;
+  }
+
+  // The setup must have drawn the same random values as the checkpointed run
+  NS_ABORT_MSG_UNLESS(checkpointed[consumer].start == start
+                        && checkpointed[consumer].expected == expected,
+                      "Consumer " << consumer << " differs from the checkpointed run.");
+
+  if (start >= offset) {
+    return start - offset;
+  }
+  consumers[consumer].received = checkpointed[consumer].received;
+  if (consumers[consumer].firstMissing() >= expected) {
+    return std::nullopt;
+  }
+
+  // Its requests were lost with the checkpoint, so ask again right away
+  return Seconds(0);
+}
+
+void
+IcarusCheckpointer::TraceConsumer(std::size_t consumer, const Ptr<Application>& app) noexcept
+{
+  NS_LOG_FUNCTION(this << consumer << app);
+
+  // Sequence numbers that ConsumerCbr sends next
+  app->SetAttribute("StartSeq", IntegerValue(consumers[consumer].firstMissing()));
+  app->TraceConnectWithoutContext("LastRetransmittedInterestDataDelay",
+                                  MakeBoundCallback(&IcarusCheckpointer::consumerData, this,
+                                                    consumer));
+}
+
+void
+IcarusCheckpointer::AttachTracer(IcarusGridTracer& tracer)
+{
+  NS_LOG_FUNCTION(this << &tracer);
+
+  this->tracer = &tracer;
+
+  if (!tracerState.empty()) {
+    std::istringstream is(tracerState);
+    tracer.LoadState(is);
+    tracerState.clear();
+  }
+}
+
+void
+IcarusCheckpointer::Schedule(Time interval) noexcept
+{
+  NS_LOG_FUNCTION(this << interval);
+
+  this->interval = interval;
+  Simulator::Schedule(interval, &IcarusCheckpointer::saveAndReschedule, this);
+}
+
+void
+IcarusCheckpointer::Save() const
+{
+  NS_LOG_FUNCTION(this);
+  NS_ASSERT(tracer != nullptr);
+
+  // Write to a temporary file first, so that a crash while saving never
+  // destroys the previous checkpoint.
+  const auto tmpPath = path + ".tmp";
+  std::ofstream os(tmpPath, std::ios_base::binary | std::ios_base::trunc);
+
+  write<uint32_t>(os, magic);
+  write<uint32_t>(os, version);
+  write<int64_t>(os, (offset + Simulator::Now()).GetNanoSeconds());
+  write<uint64_t>(os, grid.getRows());
+  write<uint64_t>(os, grid.getColumns());
+
+  std::ostringstream tracerOs;
+  tracer->SaveState(tracerOs);
+  const auto state = tracerOs.str();
+  write<uint64_t>(os, state.size());
+  os.write(state.data(), state.size());
+
+  write<uint64_t>(os, consumers.size());
+  for (const auto& consumer : consumers) {
+    write<int64_t>(os, consumer.start.GetNanoSeconds());
+    write<uint64_t>(os, consumer.expected);
+    write<uint64_t>(os, consumer.firstMissing());
+  }
+
+  for (auto row = 0u; row < grid.getRows(); row++) {
+    for (auto col = 0u; col < grid.getColumns(); col++) {
+      const auto& cs =
+        grid.GetNode(row, col)->GetObject<ndn::L3Protocol>()->getForwarder()->getCs();
+
+      write<uint64_t>(os, cs.size());
+      for (const auto& entry : cs) {
+        const auto& wire = entry.getData().wireEncode();
+        write<uint64_t>(os, wire.size());
+        os.write(reinterpret_cast<const char*>(wire.wire()), wire.size());
+      }
+    }
+  }
+
+  os.close();
+  NS_ABORT_MSG_UNLESS(os && std::rename(tmpPath.c_str(), path.c_str()) == 0,
+                      "Cannot write checkpoint " << path);
+}
+
+void
+IcarusCheckpointer::saveAndReschedule() noexcept
+{
+  NS_LOG_FUNCTION(this);
+
+  Save();
+  Simulator::Schedule(interval, &IcarusCheckpointer::saveAndReschedule, this);
+}
+
+void
+IcarusCheckpointer::consumerData(IcarusCheckpointer* self, std::size_t consumer,
+                                 Ptr<ndn::App> app, uint32_t seq, Time delay,
+                                 int32_t hops) noexcept
+{
+  NS_LOG_FUNCTION(self << consumer << app << seq << delay << hops);
+
+  auto& received = self->consumers[consumer].received;
+  if (seq >= received.size()) {
+    received.resize(seq + 1, false);
+  }
+  received[seq] = true;
+}
+
+std::size_t
+IcarusCheckpointer::ConsumerState::firstMissing() const noexcept
+{
+  return std::find(received.begin(), received.end(), false) - received.begin();
+}
+
+}
+}
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_CHECKPOINT_HPP
+#define ICARUS_CHECKPOINT_HPP
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class Application;
+
+namespace ndn {
+class App;
+}
+
+namespace icarus {
+
+class IcarusGridHelper;
+class IcarusGridTracer;
+
+// Checkpoints hold fixed-width integers in host byte order
+namespace checkpoint {
+
+template <typename T>
+void
+write(std::ostream& os, T value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T
+read(std::istream& is)
+{
+  T value{};
+  is.read(reinterpret_cast<char*>(&value), sizeof(value));
+
+  return value;
+}
+
+} // namespace checkpoint
+
+// Periodically stores the tracer counters, the consumers state and the
+// contents of every CS of the grid, so that an interrupted simulation can be
+// resumed. Events in flight at checkpoint time are not saved: consumers
+// still waiting for Data when the checkpoint was taken ask again for the
+// segments they were missing.
+class IcarusCheckpointer {
+public:
+  IcarusCheckpointer(const IcarusGridHelper& grid, const std::string& path) noexcept;
+
+  // Restores the last checkpoint and returns the time it was taken at. The
+  // simulation clock then starts at that time.
+  Time Load();
+
+  // Registers a consumer that needs the given number of Data packets and
+  // returns when it has to start, or nothing if it finished before the
+  // checkpoint. Consumers must be added in the same order in every run.
+  std::optional<Time> AddConsumer(Time start, std::size_t expected);
+  // Follows the Data received by a consumer that has not started yet. If it
+  // was half way through its object, it resumes from the first segment it
+  // was missing.
+  void TraceConsumer(std::size_t consumer, const Ptr<Application>& app) noexcept;
+
+  void AttachTracer(IcarusGridTracer& tracer);
+
+  void Schedule(Time interval) noexcept;
+  void Save() const;
+
+private:
+  const IcarusGridHelper& grid;
+  const std::string path;
+  IcarusGridTracer* tracer = nullptr;
+  Time offset;
+  Time interval;
+
+  struct ConsumerState {
+    Time start;
+    std::size_t expected = 0;
+    std::vector<bool> received;
+
+    std::size_t firstMissing() const noexcept;
+  };
+  std::vector<ConsumerState> consumers, checkpointed;
+  std::string tracerState;
+
+  void saveAndReschedule() noexcept;
+  static void consumerData(IcarusCheckpointer* self, std::size_t consumer, Ptr<ndn::App> app,
+                           uint32_t seq, Time delay, int32_t hops) noexcept;
+};
+
+}
+}
+
+#endif
@@ -19,6 +19,7 @@
  */
 
 #include "icarus-grid-helper.hpp"
+#include "ns3/channel.h"
 #include "ns3/log.h"
 
 NS_LOG_COMPONENT_DEFINE("icarus.IcarusGridHelper");
@@ -28,25 +29,59 @@ namespace icarus {
 
 IcarusGridHelper::IcarusGridHelper(std::size_t rows, std::size_t cols,
                                    PointToPointHelper& p2p) noexcept
+  : IcarusGridHelper(rows, cols, p2p, p2p)
+{
+  NS_LOG_FUNCTION(this << rows << cols << &p2p);
+}
+
+IcarusGridHelper::IcarusGridHelper(std::size_t rows, std::size_t cols,
+                                   PointToPointHelper& horizontal, PointToPointHelper& vertical,
+                                   const RowDelay& rowDelay) noexcept
   : cols(cols)
   , rows(rows)
   , deviceContainersH(rows * cols)
   , deviceContainersV(rows * cols)
 {
-  NS_LOG_FUNCTION(this << rows << cols << &p2p);
+  NS_LOG_FUNCTION(this << rows << cols << &horizontal << &vertical);
 
   nodes.Create(rows * cols);
   for (auto row = 0u; row < rows; row++) {
     for (auto col = 0u; col < cols; col++) {
       // Horizontal link
-      deviceContainersH[getIndex(row, col)] =
-        p2p.Install(nodes.Get(getIndex(row, col)), nodes.Get(getIndex(row, (col + 1) % cols)));
+      deviceContainersH[getIndex(row, col)] = horizontal.Install(
+        nodes.Get(getIndex(row, col)), nodes.Get(getIndex(row, (col + 1) % cols)));
+      if (rowDelay) {
+        deviceContainersH[getIndex(row, col)].Get(0)->GetChannel()->SetAttribute(
+          "Delay", TimeValue(rowDelay(row)));
+      }
 
       // Vertical link
-      deviceContainersV[getIndex(row, col)] =
-        p2p.Install(nodes.Get(getIndex(row, col)), nodes.Get(getIndex((row + 1) % rows, col)));
+      deviceContainersV[getIndex(row, col)] = vertical.Install(
+        nodes.Get(getIndex(row, col)), nodes.Get(getIndex((row + 1) % rows, col)));
     }
   }
 }
+
+Time
+IcarusGridHelper::getLinkDelay(std::size_t row, std::size_t col, dir direction) const noexcept
+{
+  NS_LOG_FUNCTION(this << row << col << direction);
+
+  TimeValue delay;
+  getDevice(row, col, direction)->GetChannel()->GetAttribute("Delay", delay);
+
+  return delay.Get();
+}
+
+DataRate
+IcarusGridHelper::getLinkRate(std::size_t row, std::size_t col, dir direction) const noexcept
+{
+  NS_LOG_FUNCTION(this << row << col << direction);
+
+  DataRateValue rate;
+  getDevice(row, col, direction)->GetAttribute("DataRate", rate);
+
+  return rate.Get();
+}
 }
 } // namespace icarus
@@ -21,9 +21,13 @@
 #ifndef ICARUS_GRID_HELPER_HPP
 #define ICARUS_GRID_HELPER_HPP
 
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
 #include "ns3/node.h"
 #include "ns3/point-to-point-helper.h"
 
+#include <functional>
+
 namespace ns3 {
 namespace icarus {
 
@@ -31,8 +35,16 @@ class IcarusGridHelper {
 public:
   enum dir { UP, DOWN, LEFT, RIGHT };
 
+  // Returns the delay of the horizontal links that start at a given row
+  using RowDelay = std::function<Time(std::size_t row)>;
+
   IcarusGridHelper(std::size_t rows, std::size_t cols, PointToPointHelper& p2p) noexcept;
 
+  // Horizontal and vertical links get their own profiles. If rowDelay is set,
+  // it overrides the delay of the horizontal links of every row.
+  IcarusGridHelper(std::size_t rows, std::size_t cols, PointToPointHelper& horizontal,
+                   PointToPointHelper& vertical, const RowDelay& rowDelay = nullptr) noexcept;
+
   Ptr<Node>
   GetNode(std::size_t row, std::size_t col) const noexcept
   {
@@ -58,17 +70,21 @@ public:
     case RIGHT:
       return deviceContainersH[getIndex(row, col)].Get(0);
     case LEFT:
-      return deviceContainersH[getIndex((row), (col - 1) % cols)].Get(1);
+      return deviceContainersH[getIndex(row, (col + cols - 1) % cols)].Get(1);
     case UP:
       return deviceContainersV[getIndex(row, col)].Get(0);
     case DOWN:
-      return deviceContainersV[getIndex((row - 1) % rows, col)].Get(1);
+      return deviceContainersV[getIndex((row + rows - 1) % rows, col)].Get(1);
     default:
       NS_ASSERT("Impossible direction");
       return nullptr;
     }
   }
 
+  Time getLinkDelay(std::size_t row, std::size_t col, dir direction) const noexcept;
+
+  DataRate getLinkRate(std::size_t row, std::size_t col, dir direction) const noexcept;
+
   auto
   begin() const
   {
@@ -19,11 +19,15 @@
  */
 
 #include "icarus-grid-tracer.hpp"
+#include "icarus-checkpoint.hpp"
 #include "icarus-grid-helper.hpp"
 
 #include "ns3/log-macros-disabled.h"
 #include "ns3/log.h"
 #include "ns3/ndnSIM-module.h"
+#include "ns3/ndnSIM/model/ndn-net-device-transport.hpp"
+
+#include <set>
 
 NS_LOG_COMPONENT_DEFINE("icarus.IcarusGridTracer");
 
@@ -36,22 +40,44 @@ IcarusGridTracer::IcarusGridTracer(const IcarusGridHelper& grid, std::ostream& o
   , os(os)
   , name_prefix(match_prefix)
   , stats(grid.getRows(), std::vector<NodeStats>(grid.getColumns()))
+  , hooks(grid.getRows(), std::vector<NodeHooks>(grid.getColumns()))
 {
   NS_LOG_FUNCTION(this << &grid << match_prefix);
+
+  for (auto row = 0u; row < grid.getRows(); row++) {
+    for (auto col = 0u; col < grid.getColumns(); col++) {
+      positions[grid.GetNode(row, col)->GetId()] = {row, col};
+    }
+  }
 }
 
 IcarusGridTracer::~IcarusGridTracer() noexcept
 {
   NS_LOG_FUNCTION(this);
 
-  os << "# Row\tCol\tHits\tMisses\tPackets\tBytes" << std::endl;
+  os << "# Row\tCol\tHits\tMisses\tPackets\tBytes\tAggregated\tPeakPit\tExpired\tHitBytes\t"
+        "MissBytes\tByteHitRatio"
+     << std::endl;
 
   for (auto row = 0u; row < stats.size(); row++) {
     for (auto col = 0u; col < stats[row].size(); col++) {
+      const auto dataBytes = stats[row][col].hitBytes + stats[row][col].missBytes;
+      const auto byteHitRatio =
+        dataBytes > 0 ? static_cast<double>(stats[row][col].hitBytes) / dataBytes : 0.0;
+
       os << row << '\t' << col << '\t' << stats[row][col].hits << '\t' << stats[row][col].misses
-         << '\t' << stats[row][col].txPackets << '\t' << stats[row][col].txBytes << std::endl;
+         << '\t' << stats[row][col].txPackets << '\t' << stats[row][col].txBytes << '\t'
+         << stats[row][col].aggregated << '\t' << stats[row][col].peakPit << '\t'
+         << stats[row][col].expired << '\t' << stats[row][col].hitBytes << '\t'
+         << stats[row][col].missBytes << '\t' << byteHitRatio << std::endl;
     }
   }
+
+  for (const auto& axis : axisStats) {
+    os << "# " << axis.axis << " axis: " << axis.caches << " caches, " << axis.copies
+       << " cached objects, " << axis.distinct << " distinct, " << axis.copies - axis.distinct
+       << " duplicates" << std::endl;
+  }
 }
 
 void
@@ -71,19 +97,42 @@ IcarusGridTracer::TraceNodeCS(const Ptr<Node>& node, std::size_t row, std::size_
 {
   NS_LOG_FUNCTION(this << node << row << col);
 
+  if (hooks[row][col].cs) {
+    return;
+  }
+  hooks[row][col].cs = true;
+  profileNode(node, row, col);
+
   auto l3proto = node->GetObject<ndn::L3Protocol>();
   auto fwd = l3proto->getForwarder();
 
-  fwd->afterCsHit.connect([=](ndn::Interest interest, ndn::Data) {
+  const auto hitTimer = getTimer("tracer.cs_hit");
+  const auto missTimer = getTimer("tracer.cs_miss");
+  const auto fetchTimer = getTimer("tracer.cs_fetch");
+
+  fwd->afterCsHit.connect([=](ndn::Interest interest, ndn::Data data) {
+    const IcarusProfiler::Scope scope(hitTimer);
     if (name_prefix.isPrefixOf(interest.getName())) {
       stats[row][col].hits++;
+      stats[row][col].hitBytes += data.wireEncode().size();
     }
   });
   fwd->afterCsMiss.connect([=](ndn::Interest interest) {
+    const IcarusProfiler::Scope scope(missTimer);
     if (name_prefix.isPrefixOf(interest.getName())) {
       stats[row][col].misses++;
     }
   });
+  // CS hits also satisfy the PIT entry, through the CS face. Anything else
+  // came from upstream, including the Data that just passes through nodes
+  // without a CS.
+  fwd->beforeSatisfyInterest.connect([=](const auto& entry, const auto& face, const auto& data) {
+    const IcarusProfiler::Scope scope(fetchTimer);
+    if (face.getId() != nfd::face::FACEID_CONTENT_STORE
+        && name_prefix.isPrefixOf(entry.getName())) {
+      stats[row][col].missBytes += data.wireEncode().size();
+    }
+  });
 }
 
 void
@@ -98,12 +147,267 @@ IcarusGridTracer::TraceGridCS() noexcept
   }
 }
 
+void
+IcarusGridTracer::TraceNodePit(const Ptr<Node>& node, std::size_t row, std::size_t col) noexcept
+{
+  NS_LOG_FUNCTION(this << node << row << col);
+
+  if (hooks[row][col].pit != nullptr) {
+    return;
+  }
+  profileNode(node, row, col);
+
+  auto l3proto = node->GetObject<ndn::L3Protocol>();
+  auto fwd = l3proto->getForwarder();
+
+  // Aggregation is worked out from the forwarder counters, as Interests from
+  // new downstreams that join a PIT entry are still forwarded once the
+  // retransmission suppression interval is over.
+  hooks[row][col].pit = &fwd->getCounters();
+
+  // Both aggregated and new Interests go through the CS miss pipeline once
+  // their PIT entry exists.
+  const auto pitTimer = getTimer("tracer.pit_size");
+  const auto expireTimer = getTimer("tracer.pit_expire");
+
+  const auto pit = &fwd->getPit();
+  fwd->afterCsMiss.connect([=](ndn::Interest) {
+    const IcarusProfiler::Scope scope(pitTimer);
+    stats[row][col].peakPit = std::max(stats[row][col].peakPit, pit->size());
+  });
+  fwd->beforeExpirePendingInterest.connect([=](const auto& entry) {
+    const IcarusProfiler::Scope scope(expireTimer);
+    if (name_prefix.isPrefixOf(entry.getName())) {
+      stats[row][col].expired++;
+    }
+  });
+}
+
+void
+IcarusGridTracer::TraceGridPit() noexcept
+{
+  NS_LOG_FUNCTION(this);
+
+  for (auto row = 0u; row < grid.getRows(); row++) {
+    for (auto col = 0u; col < grid.getColumns(); col++) {
+      TraceNodePit(grid.GetNode(row, col), row, col);
+    }
+  }
+}
+
+void
+IcarusGridTracer::TraceCachesCS() noexcept
+{
+  NS_LOG_FUNCTION(this);
+
+  for (auto row = 0u; row < grid.getRows(); row++) {
+    for (auto col = 0u; col < grid.getColumns(); col++) {
+      const auto node = grid.GetNode(row, col);
+      const auto fwd = node->GetObject<ndn::L3Protocol>()->getForwarder();
+
+      if (fwd->getCs().getLimit() > 0) {
+        TraceNodeCS(node, row, col);
+      }
+    }
+  }
+}
+
+void
+IcarusGridTracer::TraceRoute(const Ptr<Node>& client, const ndn::Name& name) noexcept
+{
+  NS_LOG_FUNCTION(this << client << name);
+
+  // Follow the installed FIBs from the client towards the producer. Both
+  // the Interests and the returning Data only cross these nodes.
+  std::set<uint32_t> visited;
+  std::vector<Ptr<Node>> pending{client};
+
+  while (!pending.empty()) {
+    const auto node = pending.back();
+    pending.pop_back();
+
+    if (!visited.insert(node->GetId()).second) {
+      continue;
+    }
+
+    const auto position = positions.find(node->GetId());
+    if (position == positions.end()) {
+      continue;
+    }
+    const auto [row, col] = position->second;
+
+    TraceNodeCS(node, row, col);
+    TraceNodePit(node, row, col);
+    TraceNodeTx(row, col);
+
+    const auto fwd = node->GetObject<ndn::L3Protocol>()->getForwarder();
+    const auto& entry = fwd->getFib().findLongestPrefixMatch(name);
+
+    for (const auto& nexthop : entry.getNextHops()) {
+      const auto transport =
+        dynamic_cast<ndn::NetDeviceTransport*>(nexthop.getFace().getTransport());
+      if (transport == nullptr) { // Application face
+        continue;
+      }
+
+      const auto channel = transport->GetNetDevice()->GetChannel();
+      for (auto deviceIndex = 0u; deviceIndex != channel->GetNDevices(); deviceIndex++) {
+        const auto peer = channel->GetDevice(deviceIndex)->GetNode();
+        if (peer != node) {
+          pending.push_back(peer);
+        }
+      }
+    }
+  }
+}
+
+void
+IcarusGridTracer::CountAxisCaches(std::size_t row, std::size_t col) noexcept
+{
+  NS_LOG_FUNCTION(this << row << col);
+
+  const auto countAxis = [this](const std::string& axis, const std::vector<Ptr<Node>>& nodes) {
+    AxisStats counts{axis};
+    std::set<ndn::Name> objects;
+
+    for (const auto& node : nodes) {
+      const auto& cs = node->GetObject<ndn::L3Protocol>()->getForwarder()->getCs();
+      if (cs.getLimit() == 0) {
+        continue;
+      }
+      counts.caches++;
+
+      // Every segment of an object counts as a single copy
+      std::set<ndn::Name> nodeObjects;
+      for (const auto& entry : cs) {
+        if (name_prefix.isPrefixOf(entry.getName())
+            && entry.getName().size() > name_prefix.size()) {
+          nodeObjects.insert(entry.getName().getPrefix(name_prefix.size() + 1));
+        }
+      }
+      counts.copies += nodeObjects.size();
+      objects.insert(nodeObjects.begin(), nodeObjects.end());
+    }
+
+    counts.distinct = objects.size();
+    axisStats.push_back(counts);
+  };
+
+  std::vector<Ptr<Node>> rowNodes, colNodes;
+  for (auto i = 0u; i < grid.getColumns(); i++) {
+    rowNodes.push_back(grid.GetNode(row, i));
+  }
+  for (auto i = 0u; i < grid.getRows(); i++) {
+    colNodes.push_back(grid.GetNode(i, col));
+  }
+
+  countAxis("Horizontal", rowNodes);
+  countAxis("Vertical", colNodes);
+}
+
+void
+IcarusGridTracer::CollectCounters() noexcept
+{
+  NS_LOG_FUNCTION(this);
+
+  for (auto row = 0u; row < grid.getRows(); row++) {
+    for (auto col = 0u; col < grid.getColumns(); col++) {
+      stats[row][col].aggregated = aggregated(row, col);
+      hooks[row][col].pit = nullptr;
+    }
+  }
+}
+
+std::size_t
+IcarusGridTracer::aggregated(std::size_t row, std::size_t col) const noexcept
+{
+  const auto counters = hooks[row][col].pit;
+  if (counters == nullptr) {
+    return stats[row][col].aggregated;
+  }
+
+  // Interests neither answered by the CS nor forwarded, either upstream or to
+  // the producer, joined a pending one. Unlike the other counters, these do
+  // not look at the name prefix.
+  const uint64_t answered = counters->nCsHits + counters->nOutInterests;
+  const uint64_t incoming = counters->nInInterests;
+
+  return stats[row][col].aggregated + (incoming > answered ? incoming - answered : 0);
+}
+
+void
+IcarusGridTracer::SetProfiler(IcarusProfiler* profiler) noexcept
+{
+  NS_LOG_FUNCTION(this << profiler);
+
+  this->profiler = profiler;
+  macTxTimer = getTimer("tracer.mac_tx");
+}
+
+IcarusProfiler::Timer*
+IcarusGridTracer::getTimer(const std::string& name) const noexcept
+{
+  return profiler != nullptr ? profiler->GetTimer(name) : nullptr;
+}
+
+void
+IcarusGridTracer::profileNode(const Ptr<Node>& node, std::size_t row, std::size_t col) noexcept
+{
+  if (profiler == nullptr || hooks[row][col].profiled) {
+    return;
+  }
+  hooks[row][col].profiled = true;
+
+  profiler->TraceNode(node);
+}
+
+void
+IcarusGridTracer::SaveState(std::ostream& os) const
+{
+  NS_LOG_FUNCTION(this);
+
+  for (auto row = 0u; row < stats.size(); row++) {
+    for (auto col = 0u; col < stats[row].size(); col++) {
+      const auto& nodeStats = stats[row][col];
+      for (const auto counter :
+           {nodeStats.hits, nodeStats.misses, nodeStats.txPackets, nodeStats.txBytes,
+            aggregated(row, col), nodeStats.peakPit, nodeStats.expired, nodeStats.hitBytes,
+            nodeStats.missBytes}) {
+        checkpoint::write<uint64_t>(os, counter);
+      }
+    }
+  }
+}
+
+void
+IcarusGridTracer::LoadState(std::istream& is)
+{
+  NS_LOG_FUNCTION(this);
+
+  for (auto& statsRow : stats) {
+    for (auto& nodeStats : statsRow) {
+      for (const auto counter :
+           {&nodeStats.hits, &nodeStats.misses, &nodeStats.txPackets, &nodeStats.txBytes,
+            &nodeStats.aggregated, &nodeStats.peakPit, &nodeStats.expired, &nodeStats.hitBytes,
+            &nodeStats.missBytes}) {
+        *counter = checkpoint::read<uint64_t>(is);
+      }
+    }
+  }
+}
+
 void
 IcarusGridTracer::TraceNodeTx(std::size_t row, std::size_t col) noexcept
 {
   NS_LOG_FUNCTION(this << row << col);
 
+  if (hooks[row][col].tx) {
+    return;
+  }
+  hooks[row][col].tx = true;
+
   const auto node = grid.GetNode(row, col);
+  profileNode(node, row, col);
 
   for (auto deviceIndex = 0u; deviceIndex != node->GetNDevices(); deviceIndex++) {
     auto device = node->GetDevice(deviceIndex);
@@ -117,6 +421,7 @@ IcarusGridTracer::macTxTrace(std::size_t row, std::size_t col, Ptr<const Packet>
 {
   NS_LOG_FUNCTION(this << row << col << packet);
 
+  const IcarusProfiler::Scope scope(macTxTimer);
   stats[row][col].txPackets += 1;
   stats[row][col].txBytes += packet->GetSize();
 }
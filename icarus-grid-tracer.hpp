@@ -21,8 +21,13 @@
 #ifndef ICARUS_GRID_TRACER_HPP
 #define ICARUS_GRID_TRACER_HPP
 
+#include "icarus-profiler.hpp"
+
 #include "ndn-cxx/name.hpp"
+#include "ns3/ndnSIM/NFD/daemon/fw/forwarder-counters.hpp"
 #include "ns3/packet.h"
+#include <istream>
+#include <map>
 #include <ostream>
 
 namespace ns3 {
@@ -43,6 +48,30 @@ public:
   void TraceGridTx() noexcept;
   void TraceNodeCS(const Ptr<Node>& node, std::size_t row, std::size_t col) noexcept;
   void TraceGridCS() noexcept;
+  void TraceNodePit(const Ptr<Node>& node, std::size_t row, std::size_t col) noexcept;
+  void TraceGridPit() noexcept;
+
+  // Lazy alternatives to TraceGridCS()/TraceGridTx(). Untraced nodes are
+  // still reported, with all their counters set to zero.
+  void TraceCachesCS() noexcept;
+  void TraceRoute(const Ptr<Node>& client, const ndn::Name& name) noexcept;
+
+  // Counts the objects held by the caches along the row and the column of a
+  // node, usually the producer, so that duplicated copies can be told apart.
+  // Call it once the simulation is over.
+  void CountAxisCaches(std::size_t row, std::size_t col) noexcept;
+
+  // Adds the forwarder counters of the traced nodes to their stats. Call it
+  // once the simulation is over, before it is destroyed.
+  void CollectCounters() noexcept;
+
+  // Times the tracer callbacks and counts the forwarder signals of the traced
+  // nodes. Must be set before tracing any node.
+  void SetProfiler(IcarusProfiler* profiler) noexcept;
+
+  // Counters are saved and restored in checkpoints
+  void SaveState(std::ostream& os) const;
+  void LoadState(std::istream& is);
 
 private:
   const IcarusGridHelper& grid;
@@ -53,8 +82,34 @@ private:
     std::size_t hits = 0;
     std::size_t txPackets = 0;
     std::size_t txBytes = 0;
+    std::size_t aggregated = 0; // Up to the last collection of the forwarder counters
+    std::size_t peakPit = 0;
+    std::size_t expired = 0;
+    std::size_t hitBytes = 0;
+    std::size_t missBytes = 0; // Data bytes brought from upstream
   };
   std::vector<std::vector<NodeStats>> stats;
+  struct AxisStats {
+    std::string axis;
+    std::size_t caches = 0;
+    std::size_t copies = 0;
+    std::size_t distinct = 0;
+  };
+  std::vector<AxisStats> axisStats;
+  struct NodeHooks {
+    bool cs = false;
+    bool tx = false;
+    const nfd::ForwarderCounters* pit = nullptr; // Of the traced PIT
+    bool profiled = false;
+  };
+  std::vector<std::vector<NodeHooks>> hooks;
+  std::map<uint32_t, std::pair<std::size_t, std::size_t>> positions;
+  IcarusProfiler* profiler = nullptr;
+  IcarusProfiler::Timer* macTxTimer = nullptr;
+
+  IcarusProfiler::Timer* getTimer(const std::string& name) const noexcept;
+  void profileNode(const Ptr<Node>& node, std::size_t row, std::size_t col) noexcept;
+  std::size_t aggregated(std::size_t row, std::size_t col) const noexcept;
 
   void TraceNodeTx(std::size_t row, std::size_t col) noexcept;
   void macTxTrace(std::size_t row, std::size_t col, Ptr<const Packet> packet) noexcept;
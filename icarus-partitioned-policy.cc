@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include "icarus-partitioned-policy.hpp"
+
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE("icarus.IcarusPartitionedPolicy");
+
+namespace ns3 {
+namespace icarus {
+
+std::size_t
+getPartition(const ndn::Name& object, std::size_t partitions) noexcept
+{
+  NS_ASSERT(partitions > 0);
+
+  // FNV-1a over the wire encoding, so that partitions do not depend on the
+  // platform's std::hash.
+  const auto& block = object.wireEncode();
+  uint64_t hash = 14695981039346656037ull;
+  for (auto byte = block.wire(); byte != block.wire() + block.size(); byte++) {
+    hash = (hash ^ *byte) * 1099511628211ull;
+  }
+
+  return hash % partitions;
+}
+
+IcarusPartitionedPolicy::IcarusPartitionedPolicy(std::unique_ptr<nfd::cs::Policy> inner,
+                                                 std::size_t prefixLength,
+                                                 std::size_t partition, std::size_t partitions)
+  : Policy("partitioned")
+  , inner(std::move(inner))
+  , prefixLength(prefixLength)
+  , partition(partition)
+  , partitions(partitions)
+{
+  NS_LOG_FUNCTION(this << prefixLength << partition << partitions);
+  NS_ASSERT(partition < partitions);
+
+  this->inner->beforeEvict.connect([this](EntryRef i) { this->emitSignal(beforeEvict, i); });
+}
+
+void
+IcarusPartitionedPolicy::doAfterInsert(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  if (isOwned(i)) {
+    inner->afterInsert(i);
+  }
+  else {
+    // Some other cache along the axis stores it
+    this->emitSignal(beforeEvict, i);
+  }
+}
+
+void
+IcarusPartitionedPolicy::doAfterRefresh(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  if (isOwned(i)) {
+    inner->afterRefresh(i);
+  }
+}
+
+void
+IcarusPartitionedPolicy::doBeforeErase(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  if (isOwned(i)) {
+    inner->beforeErase(i);
+  }
+}
+
+void
+IcarusPartitionedPolicy::doBeforeUse(EntryRef i)
+{
+  NS_LOG_FUNCTION(this << i->getName());
+
+  if (isOwned(i)) {
+    inner->beforeUse(i);
+  }
+}
+
+void
+IcarusPartitionedPolicy::evictEntries()
+{
+  NS_LOG_FUNCTION(this);
+
+  // Cs::setPolicy() attaches the policy to the CS and then sets its limit, so
+  // this is the first chance to attach the inner policy, which expects a CS.
+  inner->setCs(getCs());
+  inner->setLimit(getLimit());
+}
+
+bool
+IcarusPartitionedPolicy::isOwned(EntryRef i) const noexcept
+{
+  const auto& name = i->getName();
+
+  // Names too short to identify an object are always kept
+  if (name.size() <= prefixLength) {
+    return true;
+  }
+
+  return getPartition(name.getPrefix(prefixLength + 1), partitions) == partition;
+}
+
+}
+}
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_PARTITIONED_POLICY_HPP
+#define ICARUS_PARTITIONED_POLICY_HPP
+
+#include "ndn-cxx/name.hpp"
+#include "ns3/ndnSIM/NFD/daemon/table/cs-policy.hpp"
+
+#include <memory>
+
+namespace ns3 {
+namespace icarus {
+
+// Partition, out of the given number of them, that owns an object
+std::size_t getPartition(const ndn::Name& object, std::size_t partitions) noexcept;
+
+// Cache replacement policy that only keeps the objects of one partition. The
+// actual replacement decisions are delegated to an inner policy. Objects are
+// named by the first component that follows a common prefix.
+class IcarusPartitionedPolicy : public nfd::cs::Policy {
+public:
+  IcarusPartitionedPolicy(std::unique_ptr<nfd::cs::Policy> inner, std::size_t prefixLength,
+                          std::size_t partition, std::size_t partitions);
+
+private:
+  void doAfterInsert(EntryRef i) override;
+  void doAfterRefresh(EntryRef i) override;
+  void doBeforeErase(EntryRef i) override;
+  void doBeforeUse(EntryRef i) override;
+  void evictEntries() override;
+
+  bool isOwned(EntryRef i) const noexcept;
+
+  std::unique_ptr<nfd::cs::Policy> inner;
+  const std::size_t prefixLength;
+  const std::size_t partition, partitions;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include "icarus-profiler.hpp"
+#include "icarus-profiling-simulator-impl.hpp"
+
+#include "ns3/abort.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <sys/resource.h>
+
+NS_LOG_COMPONENT_DEFINE("icarus.IcarusProfiler");
+
+namespace ns3 {
+namespace icarus {
+
+namespace {
+
+// In KiB
+long
+getPeakRss() noexcept
+{
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;
+}
+
+double
+toSeconds(IcarusProfiler::Clock::duration elapsed) noexcept
+{
+  return std::chrono::duration<double>(elapsed).count();
+}
+
+}
+
+IcarusProfiler::IcarusProfiler() noexcept
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+IcarusProfiler::StartPhase(const std::string& name) noexcept
+{
+  NS_LOG_FUNCTION(this << name);
+
+  EndPhase();
+  currentPhase = name;
+  phaseStart = Clock::now();
+}
+
+void
+IcarusProfiler::EndPhase() noexcept
+{
+  NS_LOG_FUNCTION(this);
+
+  if (currentPhase.empty()) {
+    return;
+  }
+
+  phases.push_back({currentPhase, Clock::now() - phaseStart, getPeakRss()});
+  currentPhase.clear();
+}
+
+IcarusProfiler::Timer*
+IcarusProfiler::GetTimer(const std::string& name) noexcept
+{
+  return &timers[name];
+}
+
+IcarusProfiler::Timer*
+IcarusProfiler::GetEventTimer(const std::string& type) noexcept
+{
+  return &eventTimers[type];
+}
+
+std::uint64_t*
+IcarusProfiler::GetCounter(const std::string& name) noexcept
+{
+  return &counters[name];
+}
+
+void
+IcarusProfiler::TraceSimulator()
+{
+  NS_LOG_FUNCTION(this);
+
+  GlobalValue::Bind("SimulatorImplementationType",
+                    StringValue(IcarusProfilingSimulatorImpl::GetTypeId().GetName()));
+
+  const auto impl = DynamicCast<IcarusProfilingSimulatorImpl>(Simulator::GetImplementation());
+  NS_ABORT_MSG_UNLESS(impl, "The simulator was used before it could be profiled.");
+  impl->SetProfiler(this);
+}
+
+void
+IcarusProfiler::TraceNode(const Ptr<Node>& node) noexcept
+{
+  NS_LOG_FUNCTION(this << node);
+
+  // The work behind these signals is timed with the events that trigger it
+  const auto interests = GetCounter("face.interests");
+  const auto data = GetCounter("face.data");
+  const auto csHits = GetCounter("cs.hits");
+  const auto csMisses = GetCounter("cs.misses");
+  const auto satisfied = GetCounter("pit.satisfied");
+  const auto expired = GetCounter("pit.expired");
+
+  const auto fwd = node->GetObject<ndn::L3Protocol>()->getForwarder();
+
+  // Application faces are only added once the applications start
+  const auto countFace = [=](const nfd::face::Face& face) {
+    face.afterReceiveInterest.connect([=](const auto&...) { ++*interests; });
+    face.afterReceiveData.connect([=](const auto&...) { ++*data; });
+  };
+  for (const auto& face : fwd->getFaceTable()) {
+    countFace(face);
+  }
+  fwd->getFaceTable().afterAdd.connect(countFace);
+  fwd->afterCsHit.connect([=](const auto&...) { ++*csHits; });
+  fwd->afterCsMiss.connect([=](const auto&...) { ++*csMisses; });
+  fwd->beforeSatisfyInterest.connect([=](const auto&...) { ++*satisfied; });
+  fwd->beforeExpirePendingInterest.connect([=](const auto&...) { ++*expired; });
+}
+
+void
+IcarusProfiler::Write(std::ostream& os) const
+{
+  NS_LOG_FUNCTION(this);
+
+  os << "{\n  \"peak_rss_kib\": " << getPeakRss() << ",\n";
+
+  os << "  \"phases\": [";
+  for (auto phase = phases.begin(); phase != phases.end(); phase++) {
+    os << (phase == phases.begin() ? "\n" : ",\n") << "    {\"name\": \"" << phase->name
+       << "\", \"seconds\": " << toSeconds(phase->elapsed)
+       << ", \"peak_rss_kib\": " << phase->peakRss << "}";
+  }
+  os << "\n  ],\n";
+
+  os << "  \"simulator_events\": " << Simulator::GetEventCount() << ",\n";
+
+  os << "  \"event_types\": {";
+  for (auto timer = eventTimers.begin(); timer != eventTimers.end(); timer++) {
+    os << (timer == eventTimers.begin() ? "\n" : ",\n") << "    \"" << timer->first
+       << "\": {\"calls\": " << timer->second.calls
+       << ", \"seconds\": " << toSeconds(timer->second.elapsed) << "}";
+  }
+  os << "\n  },\n";
+
+  os << "  \"forwarder_signals\": {";
+  for (auto counter = counters.begin(); counter != counters.end(); counter++) {
+    os << (counter == counters.begin() ? "\n" : ",\n") << "    \"" << counter->first
+       << "\": " << counter->second;
+  }
+  os << "\n  },\n";
+
+  os << "  \"tracer_callbacks\": {";
+  for (auto timer = timers.begin(); timer != timers.end(); timer++) {
+    os << (timer == timers.begin() ? "\n" : ",\n") << "    \"" << timer->first
+       << "\": {\"calls\": " << timer->second.calls
+       << ", \"seconds\": " << toSeconds(timer->second.elapsed) << "}";
+  }
+  os << "\n  }\n}" << std::endl;
+}
+
+}
+}
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_PROFILER_HPP
+#define ICARUS_PROFILER_HPP
+
+#include "ns3/ptr.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+namespace icarus {
+
+// Wall-clock profile of a simulation: setup phases, peak memory, the time
+// spent in each type of simulator event, the number of forwarder signals of
+// each kind and the time spent in our own tracer callbacks.
+class IcarusProfiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Timer {
+    std::uint64_t calls = 0;
+    Clock::duration elapsed{};
+  };
+
+  // Measures its own lifetime. Does nothing without a timer.
+  class Scope {
+  public:
+    explicit Scope(Timer* timer) noexcept
+      : timer(timer)
+    {
+      if (timer != nullptr) {
+        start = Clock::now();
+      }
+    }
+
+    ~Scope() noexcept
+    {
+      if (timer != nullptr) {
+        timer->calls++;
+        timer->elapsed += Clock::now() - start;
+      }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    Timer* const timer;
+    Clock::time_point start;
+  };
+
+  IcarusProfiler() noexcept;
+
+  // Ends the current phase, if any, and starts a new one
+  void StartPhase(const std::string& name) noexcept;
+  void EndPhase() noexcept;
+
+  // References stay valid for the profiler lifetime
+  Timer* GetTimer(const std::string& name) noexcept;
+  Timer* GetEventTimer(const std::string& type) noexcept;
+  std::uint64_t* GetCounter(const std::string& name) noexcept;
+
+  // Times every simulator event by type. Must be called before the simulator
+  // is first used.
+  void TraceSimulator();
+
+  // Counts the forwarder signals of a node
+  void TraceNode(const Ptr<Node>& node) noexcept;
+
+  void Write(std::ostream& os) const;
+
+private:
+  struct Phase {
+    std::string name;
+    Clock::duration elapsed;
+    long peakRss;
+  };
+  std::vector<Phase> phases;
+  std::string currentPhase;
+  Clock::time_point phaseStart;
+  std::map<std::string, Timer> timers, eventTimers;
+  std::map<std::string, std::uint64_t> counters;
+};
+
+}
+}
+
+#endif
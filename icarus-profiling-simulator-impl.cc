@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include "icarus-profiling-simulator-impl.hpp"
+
+#include "ns3/log.h"
+
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+
+NS_LOG_COMPONENT_DEFINE("icarus.IcarusProfilingSimulatorImpl");
+
+namespace ns3 {
+namespace icarus {
+
+NS_OBJECT_ENSURE_REGISTERED(IcarusProfilingSimulatorImpl);
+
+namespace {
+
+std::string
+demangle(const char* name)
+{
+  int status = 0;
+  std::unique_ptr<char, decltype(&std::free)> demangled(
+    abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free);
+
+  return status == 0 ? demangled.get() : name;
+}
+
+// Runs the scheduled event within a timer. Cancelling the event through its
+// EventId cancels this wrapper instead, which then never runs it.
+class TimedEvent : public EventImpl {
+public:
+  TimedEvent(EventImpl* event, IcarusProfiler::Timer* timer) noexcept
+    : event(event)
+    , timer(timer)
+  {
+  }
+
+  ~TimedEvent() override
+  {
+    event->Unref();
+  }
+
+private:
+  void
+  Notify() override
+  {
+    const IcarusProfiler::Scope scope(timer);
+    event->Invoke();
+  }
+
+  EventImpl* const event; // Owns the reference handed to the simulator
+  IcarusProfiler::Timer* const timer;
+};
+
+}
+
+TypeId
+IcarusProfilingSimulatorImpl::GetTypeId()
+{
+  static TypeId tid = TypeId("ns3::icarus::IcarusProfilingSimulatorImpl")
+                        .SetParent<DefaultSimulatorImpl>()
+                        .SetGroupName("Icarus")
+                        .AddConstructor<IcarusProfilingSimulatorImpl>();
+
+  return tid;
+}
+
+IcarusProfilingSimulatorImpl::IcarusProfilingSimulatorImpl() noexcept
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+IcarusProfilingSimulatorImpl::SetProfiler(IcarusProfiler* profiler) noexcept
+{
+  NS_LOG_FUNCTION(this << profiler);
+
+  this->profiler = profiler;
+  timers.clear();
+}
+
+EventId
+IcarusProfilingSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+  return DefaultSimulatorImpl::Schedule(delay, timed(event));
+}
+
+void
+IcarusProfilingSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay,
+                                                  EventImpl* event)
+{
+  DefaultSimulatorImpl::ScheduleWithContext(context, delay, timed(event));
+}
+
+EventId
+IcarusProfilingSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+  return DefaultSimulatorImpl::ScheduleNow(timed(event));
+}
+
+EventImpl*
+IcarusProfilingSimulatorImpl::timed(EventImpl* event)
+{
+  // Some schedulers fall back on the others
+  if (profiler == nullptr || dynamic_cast<TimedEvent*>(event) != nullptr) {
+    return event;
+  }
+
+  // Looking the type name up for every event would cost more than the event
+  const std::type_index type(typeid(*event));
+  auto timer = timers.find(type);
+  if (timer == timers.end()) {
+    timer = timers.emplace(type, profiler->GetEventTimer(demangle(type.name()))).first;
+  }
+
+  return new TimedEvent(event, timer->second);
+}
+
+}
+}
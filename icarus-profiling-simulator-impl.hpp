@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_PROFILING_SIMULATOR_IMPL_HPP
+#define ICARUS_PROFILING_SIMULATOR_IMPL_HPP
+
+#include "icarus-profiler.hpp"
+
+#include "ns3/default-simulator-impl.h"
+
+#include <typeindex>
+#include <unordered_map>
+
+namespace ns3 {
+namespace icarus {
+
+// Default simulator that times every event it runs. Events are told apart by
+// the type of their implementation, which names the class and signature of
+// the scheduled method. Select it through the SimulatorImplementationType
+// global value before the simulator is first used.
+class IcarusProfilingSimulatorImpl : public DefaultSimulatorImpl {
+public:
+  static TypeId GetTypeId();
+
+  IcarusProfilingSimulatorImpl() noexcept;
+
+  // Events scheduled before a profiler is set are not timed
+  void SetProfiler(IcarusProfiler* profiler) noexcept;
+
+  EventId Schedule(const Time& delay, EventImpl* event) override;
+  void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+  EventId ScheduleNow(EventImpl* event) override;
+
+private:
+  IcarusProfiler* profiler = nullptr;
+  std::unordered_map<std::type_index, IcarusProfiler::Timer*> timers;
+
+  EventImpl* timed(EventImpl* event);
+};
+
+}
+}
+
+#endif
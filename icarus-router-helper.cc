@@ -20,6 +20,8 @@
 
 #include "icarus-router-helper.hpp"
 #include "icarus-grid-helper.hpp"
+#include "icarus-partitioned-policy.hpp"
+#include "icarus-router-policies.hpp"
 #include "ns3/abort.h"
 #include "ns3/log-macros-disabled.h"
 #include "ns3/log.h"
@@ -28,6 +30,7 @@
 #include "ns3/random-variable-stream.h"
 #include <algorithm>
 #include <iterator>
+#include <map>
 #include <memory>
 
 namespace ns3 {
@@ -43,13 +46,64 @@ public:
   void addCacheLocations(const std::vector<std::size_t>& horizontal,
                          const std::vector<std::size_t>& vertical) override;
 
+  // Looks the caches up once for all the origins
+  std::vector<IcarusGridHelper::dir>
+  computeRoutes(const ndn::Name& prefix, std::size_t dstRow, std::size_t dstCol) const override;
+
 protected:
-  virtual void doAddRoute(const ndn::Name& prefix, std::size_t origRow, std::size_t origCol,
-                          std::size_t dstRow, std::size_t dstCol) override;
+  IcarusGridHelper::dir doRoute(const ndn::Name& prefix, std::size_t origRow,
+                                std::size_t origCol, std::size_t dstRow,
+                                std::size_t dstCol) const override;
+
+  // Caches that may hold content under prefix
+  virtual std::vector<std::size_t> getHorizontalCaches(const ndn::Name& prefix) const;
+  virtual std::vector<std::size_t> getVerticalCaches(const ndn::Name& prefix) const;
 
-private:
   std::vector<std::size_t> hcaches, vcaches;
+
+private:
+  IcarusGridHelper::dir route(std::size_t origRow, std::size_t origCol, std::size_t dstRow,
+                              std::size_t dstCol, const std::vector<std::size_t>& horizontal,
+                              const std::vector<std::size_t>& vertical) const;
 };
+
+// Caches along an axis split the objects among them, so each route only
+// heads for the cache that owns its object. Prefixes are object names.
+class CoordinatedLocationsRouterGridHelper : public OptLocationsRouterGridHelper {
+public:
+  CoordinatedLocationsRouterGridHelper(const IcarusGridHelper& grid);
+
+protected:
+  std::vector<std::size_t> getHorizontalCaches(const ndn::Name& prefix) const override;
+  std::vector<std::size_t> getVerticalCaches(const ndn::Name& prefix) const override;
+};
+
+// Size used to account for the transmission time of a Data packet
+constexpr uint32_t referencePacketSize = 1024;
+
+Time
+getLinkCost(const IcarusGridHelper& grid, std::size_t row, std::size_t col,
+            IcarusGridHelper::dir direction)
+{
+  const auto rate = grid.getLinkRate(row, col, direction);
+
+  return grid.getLinkDelay(row, col, direction)
+         + Seconds(referencePacketSize * 8.0 / rate.GetBitRate());
+}
+
+int32_t
+getMetric(const IcarusGridHelper& grid, std::size_t row, std::size_t col,
+          IcarusGridHelper::dir direction)
+{
+  return std::max<int64_t>(1, getLinkCost(grid, row, col, direction).GetMicroSeconds());
+}
+
+template <typename Helper>
+std::unique_ptr<IcarusRouterGridHelper>
+makeRouterHelper(const IcarusGridHelper& grid)
+{
+  return std::make_unique<Helper>(grid);
+}
 }
 
 IcarusRouterGridHelper::~IcarusRouterGridHelper()
@@ -63,13 +117,25 @@ IcarusRouterGridHelper::CreateRouterHelper(const std::string& algorithm,
 {
   NS_LOG_FUNCTION(algorithm << &grid);
 
-  if (algorithm == "OptLocations") {
-    return std::make_unique<OptLocationsRouterGridHelper>(grid);
-  }
+  using Factory = std::unique_ptr<IcarusRouterGridHelper> (*)(const IcarusGridHelper&);
+
+  // Policy based helpers only exist for the combinations listed here
+  static const std::map<std::string, Factory> registry = {
+    {"OptLocations", &makeRouterHelper<OptLocationsRouterGridHelper>},
+    {"CoordinatedLocations", &makeRouterHelper<CoordinatedLocationsRouterGridHelper>},
+    {"InAxis", &makeRouterHelper<PolicyRouterGridHelper<CachePreference, NoWrap, TableLookup>>},
+    {"InAxisScan", &makeRouterHelper<PolicyRouterGridHelper<CachePreference, NoWrap, ScanLookup>>},
+    {"InAxisWrap",
+     &makeRouterHelper<PolicyRouterGridHelper<CachePreference, ShortestWrap, TableLookup>>},
+    {"HorizontalFirst",
+     &makeRouterHelper<PolicyRouterGridHelper<HorizontalFirst, NoWrap, TableLookup>>},
+    {"VerticalFirst", &makeRouterHelper<PolicyRouterGridHelper<VerticalFirst, NoWrap, TableLookup>>},
+  };
 
-  NS_ABORT_MSG("Not a valid routing algorithm.");
+  const auto factory = registry.find(algorithm);
+  NS_ABORT_MSG_IF(factory == registry.end(), "Not a valid routing algorithm.");
 
-  return nullptr;
+  return factory->second(grid);
 }
 
 IcarusRouterGridHelper::IcarusRouterGridHelper(const IcarusGridHelper& grid)
@@ -83,11 +149,39 @@ IcarusRouterGridHelper::addRoute(const ndn::Name& prefix, std::size_t dstRow, st
 {
   NS_LOG_FUNCTION(this << prefix << dstRow << dstCol);
 
+  const auto routes = computeRoutes(prefix, dstRow, dstCol);
+
+  for (std::size_t origRow = 0u; origRow < grid.getRows(); origRow++) {
+    for (std::size_t origCol = 0u; origCol < grid.getColumns(); origCol++) {
+      installRoute(prefix, origRow, origCol, routes[origRow * grid.getColumns() + origCol]);
+    }
+  }
+}
+
+std::vector<IcarusGridHelper::dir>
+IcarusRouterGridHelper::computeRoutes(const ndn::Name& prefix, std::size_t dstRow,
+                                      std::size_t dstCol) const
+{
+  NS_LOG_FUNCTION(this << prefix << dstRow << dstCol);
+
+  std::vector<IcarusGridHelper::dir> routes;
+  routes.reserve(grid.getRows() * grid.getColumns());
+
   for (std::size_t origRow = 0u; origRow < grid.getRows(); origRow++) {
     for (std::size_t origCol = 0u; origCol < grid.getColumns(); origCol++) {
-      doAddRoute(prefix, origRow, origCol, dstRow, dstCol);
+      routes.push_back(doRoute(prefix, origRow, origCol, dstRow, dstCol));
     }
   }
+
+  return routes;
+}
+
+void
+IcarusRouterGridHelper::useLinkCost(bool enable) noexcept
+{
+  NS_LOG_FUNCTION(this << enable);
+
+  linkCost = enable;
 }
 
 auto
@@ -96,41 +190,56 @@ IcarusRouterGridHelper::pos_dif(std::size_t a, std::size_t b) const noexcept
   return std::max(a, b) - std::min(a, b);
 }
 
-void
-IcarusRouterGridHelper::addRouteH(const ndn::Name& prefix, std::size_t row, std::size_t origCol,
-                                  std::size_t dstCol)
+Time
+IcarusRouterGridHelper::pathCost(std::size_t origRow, std::size_t origCol, std::size_t dstRow,
+                                 std::size_t dstCol, bool horizontalFirst) const
 {
-  NS_LOG_FUNCTION(this << prefix << row << origCol << dstCol);
+  NS_LOG_FUNCTION(this << origRow << origCol << dstRow << dstCol << horizontalFirst);
 
-  auto dir = IcarusGridHelper::RIGHT;
-  if (dstCol < origCol) { // FIXME: Consider circular routes
-    dir = IcarusGridHelper::LEFT;
+  // Both paths are the same as the ones built by routeH() and routeV()
+  const auto cornerRow = horizontalFirst ? origRow : dstRow;
+  const auto cornerCol = horizontalFirst ? dstCol : origCol;
+  Time cost;
+
+  for (auto col = origCol; col != dstCol;) {
+    const auto dir = dstCol < col ? IcarusGridHelper::LEFT : IcarusGridHelper::RIGHT;
+    cost += getLinkCost(grid, cornerRow, col, dir);
+    col = dir == IcarusGridHelper::LEFT ? col - 1 : col + 1;
+  }
+  for (auto row = origRow; row != dstRow;) {
+    const auto dir = dstRow < row ? IcarusGridHelper::DOWN : IcarusGridHelper::UP;
+    cost += getLinkCost(grid, row, cornerCol, dir);
+    row = dir == IcarusGridHelper::DOWN ? row - 1 : row + 1;
   }
 
-  const auto device = grid.getDevice(row, origCol, dir);
-  auto node = grid.GetNode(row, origCol);
-  auto ndn = node->GetObject<ndn::L3Protocol>();
-  auto face = ndn->getFaceByNetDevice(device);
+  return cost;
+}
 
-  fibHelper.AddRoute(node, prefix, face, 1);
+IcarusGridHelper::dir
+IcarusRouterGridHelper::routeH(std::size_t origCol, std::size_t dstCol) const noexcept
+{
+  // FIXME: Consider circular routes
+  return dstCol < origCol ? IcarusGridHelper::LEFT : IcarusGridHelper::RIGHT;
+}
+
+IcarusGridHelper::dir
+IcarusRouterGridHelper::routeV(std::size_t origRow, std::size_t dstRow) const noexcept
+{
+  return dstRow < origRow ? IcarusGridHelper::DOWN : IcarusGridHelper::UP;
 }
 
 void
-IcarusRouterGridHelper::addRouteV(const ndn::Name& prefix, std::size_t origRow, std::size_t col,
-                                  std::size_t dstRow)
+IcarusRouterGridHelper::installRoute(const ndn::Name& prefix, std::size_t row, std::size_t col,
+                                     IcarusGridHelper::dir direction)
 {
-  NS_LOG_FUNCTION(this << prefix << origRow << col << dstRow);
+  NS_LOG_FUNCTION(this << prefix << row << col << direction);
 
-  auto dir = IcarusGridHelper::UP;
-  if (dstRow < origRow) {
-    dir = IcarusGridHelper::DOWN;
-  }
-  const auto device = grid.getDevice(origRow, col, dir);
-  auto node = grid.GetNode(origRow, col);
+  const auto device = grid.getDevice(row, col, direction);
+  auto node = grid.GetNode(row, col);
   auto ndn = node->GetObject<ndn::L3Protocol>();
   auto face = ndn->getFaceByNetDevice(device);
 
-  fibHelper.AddRoute(node, prefix, face, 1);
+  fibHelper.AddRoute(node, prefix, face, linkCost ? getMetric(grid, row, col, direction) : 1);
 }
 
 OptLocationsRouterGridHelper::OptLocationsRouterGridHelper(const IcarusGridHelper& grid)
@@ -149,13 +258,44 @@ OptLocationsRouterGridHelper::addCacheLocations(const std::vector<std::size_t>&
   vcaches = vertical;
 }
 
-void
-OptLocationsRouterGridHelper::doAddRoute(const ndn::Name& prefix, std::size_t origRow,
-                                         std::size_t origCol, std::size_t dstRow,
-                                         std::size_t dstCol)
+std::vector<IcarusGridHelper::dir>
+OptLocationsRouterGridHelper::computeRoutes(const ndn::Name& prefix, std::size_t dstRow,
+                                            std::size_t dstCol) const
+{
+  NS_LOG_FUNCTION(this << prefix << dstRow << dstCol);
+
+  const auto horizontal = getHorizontalCaches(prefix);
+  const auto vertical = getVerticalCaches(prefix);
+
+  std::vector<IcarusGridHelper::dir> routes;
+  routes.reserve(getGrid().getRows() * getGrid().getColumns());
+
+  for (std::size_t origRow = 0u; origRow < getGrid().getRows(); origRow++) {
+    for (std::size_t origCol = 0u; origCol < getGrid().getColumns(); origCol++) {
+      routes.push_back(route(origRow, origCol, dstRow, dstCol, horizontal, vertical));
+    }
+  }
+
+  return routes;
+}
+
+IcarusGridHelper::dir
+OptLocationsRouterGridHelper::doRoute(const ndn::Name& prefix, std::size_t origRow,
+                                      std::size_t origCol, std::size_t dstRow,
+                                      std::size_t dstCol) const
 {
   NS_LOG_FUNCTION(this << prefix << origRow << origCol << dstRow << dstCol);
 
+  return route(origRow, origCol, dstRow, dstCol, getHorizontalCaches(prefix),
+               getVerticalCaches(prefix));
+}
+
+IcarusGridHelper::dir
+OptLocationsRouterGridHelper::route(std::size_t origRow, std::size_t origCol,
+                                    std::size_t dstRow, std::size_t dstCol,
+                                    const std::vector<std::size_t>& horizontal,
+                                    const std::vector<std::size_t>& vertical) const
+{
   const size_t vdistance = pos_dif(origRow, dstRow);
   const size_t hdistance = pos_dif(origCol, dstCol);
 
@@ -174,25 +314,70 @@ OptLocationsRouterGridHelper::doAddRoute(const ndn::Name& prefix, std::size_t or
   // Step 1: Filter out caches that are further than us to the destination
   //         in any axe.
   // Step 2: Find closest cache location to us of the remaining ones
-  const std::size_t besth = best(hdistance, hcaches);
-  const std::size_t bestv = best(vdistance, vcaches);
+  const std::size_t besth = best(hdistance, horizontal);
+  const std::size_t bestv = best(vdistance, vertical);
 
   // Step 3: Choose direction according to closest cache location.
 
   if (dstCol == origCol) {
-    return addRouteV(prefix, origRow, origCol, dstRow);
+    return routeV(origRow, dstRow);
   }
   else if (dstRow == origRow) {
-    return addRouteH(prefix, origRow, origCol, dstCol);
+    return routeH(origCol, dstCol);
   }
   else if (bestv > besth) {
-    return addRouteH(prefix, origRow, origCol, dstCol);
+    return routeH(origCol, dstCol);
+  }
+  else if (bestv == besth && usesLinkCost()
+           && pathCost(origRow, origCol, dstRow, dstCol, true)
+                < pathCost(origRow, origCol, dstRow, dstCol, false)) {
+    return routeH(origCol, dstCol);
   }
   else if (bestv <= besth) {
-    return addRouteV(prefix, origRow, origCol, dstRow);
+    return routeV(origRow, dstRow);
   }
 
   NS_ABORT_MSG("Unhandled route.");
+
+  return IcarusGridHelper::UP;
+}
+
+std::vector<std::size_t>
+OptLocationsRouterGridHelper::getHorizontalCaches(const ndn::Name& prefix) const
+{
+  return hcaches;
+}
+
+std::vector<std::size_t>
+OptLocationsRouterGridHelper::getVerticalCaches(const ndn::Name& prefix) const
+{
+  return vcaches;
+}
+
+CoordinatedLocationsRouterGridHelper::CoordinatedLocationsRouterGridHelper(
+  const IcarusGridHelper& grid)
+  : OptLocationsRouterGridHelper(grid)
+{
+}
+
+std::vector<std::size_t>
+CoordinatedLocationsRouterGridHelper::getHorizontalCaches(const ndn::Name& prefix) const
+{
+  if (hcaches.empty()) {
+    return {};
+  }
+
+  return {hcaches[getPartition(prefix, hcaches.size())]};
+}
+
+std::vector<std::size_t>
+CoordinatedLocationsRouterGridHelper::getVerticalCaches(const ndn::Name& prefix) const
+{
+  if (vcaches.empty()) {
+    return {};
+  }
+
+  return {vcaches[getPartition(prefix, vcaches.size())]};
 }
 
 }
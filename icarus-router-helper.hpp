@@ -21,8 +21,11 @@
 #ifndef ICARUS_ROUTER_HELPER_HPP
 #define ICARUS_ROUTER_HELPER_HPP
 
+#include "icarus-grid-helper.hpp"
+
 #include "ndn-cxx/name.hpp"
 #include "ns3/ndnSIM/helper/ndn-fib-helper.hpp"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -30,8 +33,6 @@ class UniformRandomVariable;
 
 namespace icarus {
 
-class IcarusGridHelper;
-
 class IcarusRouterGridHelper {
 public:
   virtual ~IcarusRouterGridHelper();
@@ -41,27 +42,59 @@ public:
 
   void addRoute(const ndn::Name& prefix, std::size_t dstRow, std::size_t dstCol);
 
+  // Direction taken at every node, indexed by row * columns + column. Does
+  // not touch the FIBs.
+  virtual std::vector<IcarusGridHelper::dir>
+  computeRoutes(const ndn::Name& prefix, std::size_t dstRow, std::size_t dstCol) const;
+
   virtual void
   addCacheLocations(const std::vector<std::size_t>& horizontal,
                     const std::vector<std::size_t>& vertical)
   {
   }
 
+  // Use link delay and rate both as FIB metric and to break ties between axes.
+  // Both paths cross the same number of links of each axis, so ties are only
+  // broken when the delay depends on the row. Every node has a single nexthop,
+  // so the metric does not change forwarding.
+  virtual void useLinkCost(bool enable) noexcept;
+
 protected:
   IcarusRouterGridHelper(const IcarusGridHelper& grid);
 
   auto pos_dif(std::size_t a, std::size_t b) const noexcept;
 
-  virtual void doAddRoute(const ndn::Name& prefix, std::size_t origRow, std::size_t origCol,
-                          std::size_t dstRow, std::size_t dstCol) = 0;
+  const IcarusGridHelper&
+  getGrid() const noexcept
+  {
+    return grid;
+  }
+
+  bool
+  usesLinkCost() const noexcept
+  {
+    return linkCost;
+  }
+
+  // Cost of the path that first moves along the horizontal (or vertical) axis
+  Time pathCost(std::size_t origRow, std::size_t origCol, std::size_t dstRow, std::size_t dstCol,
+                bool horizontalFirst) const;
+
+  virtual IcarusGridHelper::dir doRoute(const ndn::Name& prefix, std::size_t origRow,
+                                        std::size_t origCol, std::size_t dstRow,
+                                        std::size_t dstCol) const = 0;
 
-  void addRouteH(const ndn::Name& prefix, std::size_t row, std::size_t origCol, std::size_t dstCol);
+  IcarusGridHelper::dir routeH(std::size_t origCol, std::size_t dstCol) const noexcept;
 
-  void addRouteV(const ndn::Name& prefix, std::size_t origRow, std::size_t col, std::size_t dstRow);
+  IcarusGridHelper::dir routeV(std::size_t origRow, std::size_t dstRow) const noexcept;
 
 private:
   const IcarusGridHelper& grid;
   ndn::FibHelper fibHelper;
+  bool linkCost = false;
+
+  void installRoute(const ndn::Name& prefix, std::size_t row, std::size_t col,
+                    IcarusGridHelper::dir direction);
 };
 
 }
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_ROUTER_POLICIES_HPP
+#define ICARUS_ROUTER_POLICIES_HPP
+
+#include "icarus-grid-helper.hpp"
+#include "icarus-router-helper.hpp"
+
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+namespace icarus {
+
+// Wrap handling: distance between two positions of an axis of a given
+// length, and whether to move towards increasing positions.
+
+struct NoWrap {
+  static std::size_t
+  distance(std::size_t orig, std::size_t dst, std::size_t) noexcept
+  {
+    return std::max(orig, dst) - std::min(orig, dst);
+  }
+
+  static bool
+  forward(std::size_t orig, std::size_t dst, std::size_t) noexcept
+  {
+    return dst >= orig;
+  }
+};
+
+// Takes the shortest way around the torus. Distances to the caches are
+// measured the same way.
+struct ShortestWrap {
+  static std::size_t
+  distance(std::size_t orig, std::size_t dst, std::size_t length) noexcept
+  {
+    const auto forward = (dst + length - orig) % length;
+    return std::min(forward, length - forward);
+  }
+
+  static bool
+  forward(std::size_t orig, std::size_t dst, std::size_t length) noexcept
+  {
+    return (dst + length - orig) % length <= length / 2;
+  }
+};
+
+// Cache distance lookup: the furthest cache from the destination that is not
+// further than a given distance, or 0 if there is none.
+
+class ScanLookup {
+public:
+  void
+  setCaches(const std::vector<std::size_t>& caches, std::size_t) noexcept
+  {
+    this->caches = caches;
+  }
+
+  std::size_t
+  best(std::size_t distance) const noexcept
+  {
+    std::size_t best = 0;
+
+    for (const std::size_t cache : caches) {
+      if (cache <= distance) {
+        best = std::max(best, cache);
+      }
+    }
+
+    return best;
+  }
+
+private:
+  std::vector<std::size_t> caches;
+};
+
+// Precomputes the answer for every distance along the axis
+class TableLookup {
+public:
+  void
+  setCaches(const std::vector<std::size_t>& caches, std::size_t length) noexcept
+  {
+    table.assign(length + 1, 0);
+
+    for (const std::size_t cache : caches) {
+      for (auto distance = cache; distance < table.size(); distance++) {
+        table[distance] = std::max(table[distance], cache);
+      }
+    }
+  }
+
+  std::size_t
+  best(std::size_t distance) const noexcept
+  {
+    return table[distance];
+  }
+
+private:
+  std::vector<std::size_t> table;
+};
+
+// Axis preference: whether to leave along the horizontal axis when both
+// axes lead to the destination.
+
+// Heads for the axis with the cache closest to us, vertical on ties
+struct CachePreference {
+  template <typename Lookup>
+  static bool
+  horizontal(std::size_t hdistance, std::size_t vdistance, const Lookup& hcaches,
+             const Lookup& vcaches) noexcept
+  {
+    return vcaches.best(vdistance) > hcaches.best(hdistance);
+  }
+};
+
+struct HorizontalFirst {
+  template <typename Lookup>
+  static bool
+  horizontal(std::size_t, std::size_t, const Lookup&, const Lookup&) noexcept
+  {
+    return true;
+  }
+};
+
+struct VerticalFirst {
+  template <typename Lookup>
+  static bool
+  horizontal(std::size_t, std::size_t, const Lookup&, const Lookup&) noexcept
+  {
+    return false;
+  }
+};
+
+// Router whose rules are fixed at compile time, so that computing the
+// routes of all the grid is a single loop without virtual calls.
+template <typename AxisPreference, typename Wrap, typename CacheLookup>
+class PolicyRouterGridHelper : public IcarusRouterGridHelper {
+public:
+  explicit PolicyRouterGridHelper(const IcarusGridHelper& grid)
+    : IcarusRouterGridHelper(grid)
+  {
+    hcaches.setCaches({}, grid.getColumns());
+    vcaches.setCaches({}, grid.getRows());
+  }
+
+  void
+  addCacheLocations(const std::vector<std::size_t>& horizontal,
+                    const std::vector<std::size_t>& vertical) override
+  {
+    hcaches.setCaches(horizontal, getGrid().getColumns());
+    vcaches.setCaches(vertical, getGrid().getRows());
+  }
+
+  // Routes are fixed by the policies, so link costs cannot break ties
+  void
+  useLinkCost(bool enable) noexcept override
+  {
+    NS_ABORT_MSG_IF(enable, "Link costs are only supported by OptLocations and "
+                            "CoordinatedLocations.");
+  }
+
+  std::vector<IcarusGridHelper::dir>
+  computeRoutes(const ndn::Name&, std::size_t dstRow, std::size_t dstCol) const override
+  {
+    const auto rows = getGrid().getRows();
+    const auto cols = getGrid().getColumns();
+    std::vector<IcarusGridHelper::dir> routes(rows * cols);
+
+    for (std::size_t origRow = 0u; origRow < rows; origRow++) {
+      const auto vdistance = Wrap::distance(origRow, dstRow, rows);
+      const auto vdir =
+        Wrap::forward(origRow, dstRow, rows) ? IcarusGridHelper::UP : IcarusGridHelper::DOWN;
+
+      for (std::size_t origCol = 0u; origCol < cols; origCol++) {
+        routes[origRow * cols + origCol] = route(origRow, origCol, dstRow, dstCol, vdistance, vdir);
+      }
+    }
+
+    return routes;
+  }
+
+protected:
+  IcarusGridHelper::dir
+  doRoute(const ndn::Name&, std::size_t origRow, std::size_t origCol, std::size_t dstRow,
+          std::size_t dstCol) const override
+  {
+    const auto rows = getGrid().getRows();
+
+    return route(origRow, origCol, dstRow, dstCol, Wrap::distance(origRow, dstRow, rows),
+                 Wrap::forward(origRow, dstRow, rows) ? IcarusGridHelper::UP
+                                                      : IcarusGridHelper::DOWN);
+  }
+
+private:
+  CacheLookup hcaches, vcaches;
+
+  IcarusGridHelper::dir
+  route(std::size_t origRow, std::size_t origCol, std::size_t dstRow, std::size_t dstCol,
+        std::size_t vdistance, IcarusGridHelper::dir vdir) const noexcept
+  {
+    const auto cols = getGrid().getColumns();
+
+    if (dstCol == origCol) {
+      return vdir;
+    }
+
+    const auto hdir =
+      Wrap::forward(origCol, dstCol, cols) ? IcarusGridHelper::RIGHT : IcarusGridHelper::LEFT;
+    if (dstRow == origRow) {
+      return hdir;
+    }
+
+    return AxisPreference::horizontal(Wrap::distance(origCol, dstCol, cols), vdistance, hcaches,
+                                      vcaches)
+             ? hdir
+             : vdir;
+  }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include "icarus-sized-producer.hpp"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("icarus.IcarusSizedProducer");
+
+namespace ns3 {
+namespace icarus {
+
+NS_OBJECT_ENSURE_REGISTERED(IcarusSizedProducer);
+
+TypeId
+IcarusSizedProducer::GetTypeId()
+{
+  static TypeId tid = TypeId("ns3::icarus::IcarusSizedProducer")
+                        .SetParent<ndn::Producer>()
+                        .SetGroupName("Icarus")
+                        .AddConstructor<IcarusSizedProducer>();
+
+  return tid;
+}
+
+IcarusSizedProducer::IcarusSizedProducer() noexcept
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+IcarusSizedProducer::SetObjectSizes(const std::vector<std::size_t>& sizes,
+                                    std::size_t prefixLength, std::size_t segmentSize) noexcept
+{
+  NS_LOG_FUNCTION(this << sizes.size() << prefixLength << segmentSize);
+
+  this->sizes = sizes;
+  this->prefixLength = prefixLength;
+  this->segmentSize = segmentSize;
+}
+
+void
+IcarusSizedProducer::OnInterest(std::shared_ptr<const ndn::Interest> interest)
+{
+  NS_LOG_FUNCTION(this << interest->getName());
+
+  const auto& name = interest->getName();
+  if (!sizes.empty() && name.size() > prefixLength + 1) {
+    const auto object = name.get(prefixLength).toSequenceNumber();
+    const auto offset = name.get(prefixLength + 1).toSequenceNumber() * segmentSize;
+
+    // The producer builds the Data packet, so only its payload size changes
+    auto payload = segmentSize;
+    if (object < sizes.size() && offset < sizes[object]) {
+      payload = std::min(segmentSize, sizes[object] - offset);
+    }
+    SetAttribute("PayloadSize", UintegerValue(payload));
+  }
+
+  ndn::Producer::OnInterest(interest);
+}
+
+}
+}
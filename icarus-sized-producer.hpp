@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2022 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#ifndef ICARUS_SIZED_PRODUCER_HPP
+#define ICARUS_SIZED_PRODUCER_HPP
+
+#include "ns3/ndnSIM/apps/ndn-producer.hpp"
+
+#include <vector>
+
+namespace ns3 {
+namespace icarus {
+
+// Producer of objects of different sizes, named prefix/object/segment. Every
+// segment carries PayloadSize bytes, except the last one of an object, which
+// only carries the rest of it.
+class IcarusSizedProducer : public ndn::Producer {
+public:
+  static TypeId GetTypeId();
+
+  IcarusSizedProducer() noexcept;
+
+  // Sizes in bytes, indexed by object number. Without them every Data packet
+  // carries PayloadSize bytes.
+  void SetObjectSizes(const std::vector<std::size_t>& sizes, std::size_t prefixLength,
+                      std::size_t segmentSize) noexcept;
+
+  void OnInterest(std::shared_ptr<const ndn::Interest> interest) override;
+
+private:
+  std::vector<std::size_t> sizes;
+  std::size_t prefixLength = 0;
+  std::size_t segmentSize = 0;
+};
+
+}
+}
+
+#endif
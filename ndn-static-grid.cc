@@ -18,10 +18,16 @@
  * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
  */
 
+#include "icarus-byte-lru-policy.hpp"
+#include "icarus-checkpoint.hpp"
 #include "icarus-grid-helper.hpp"
 #include "icarus-grid-tracer.hpp"
+#include "icarus-partitioned-policy.hpp"
+#include "icarus-profiler.hpp"
 #include "icarus-router-helper.hpp"
+#include "icarus-sized-producer.hpp"
 
+#include "ns3/abort.h"
 #include "ns3/command-line.h"
 #include "ns3/config.h"
 #include "ns3/double.h"
@@ -32,10 +38,14 @@
 #include "ns3/string.h"
 #include "src/core/model/uinteger.h"
 #include <cstddef>
+#include <limits>
 #include <sstream>
 #include <vector>
 
 #include <boost/tokenizer.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 
 using namespace ns3;
 
@@ -56,6 +66,46 @@ vec_from_string(const std::string& str) -> std::vector<std::size_t>
   return values;
 }
 
+auto
+default_link_delay() -> Time
+{
+  TypeId::AttributeInformation info;
+  TypeId::LookupByName("ns3::PointToPointChannel").LookupAttributeByName("Delay", &info);
+
+  return DynamicCast<const TimeValue>(info.initialValue)->Get();
+}
+
+// Times the route computation of several router helpers, without FIBs
+auto
+benchmark_routes(const IcarusGridHelper& grid, const std::vector<std::size_t>& hcaches,
+                 const std::vector<std::size_t>& vcaches, std::size_t iterations) -> void
+{
+  const ndn::Name prefix("/icarus/static-grid/route-benchmark");
+  std::vector<IcarusGridHelper::dir> reference;
+
+  std::cout << "# " << grid.getRows() << 'x' << grid.getColumns() << " grid, " << iterations
+            << " iterations" << std::endl;
+  std::cout << "# Router\tMicroseconds\tSame routes" << std::endl;
+  for (const auto algorithm : {"OptLocations", "InAxisScan", "InAxis"}) {
+    auto routerHelper = IcarusRouterGridHelper::CreateRouterHelper(algorithm, grid);
+    routerHelper->addCacheLocations(hcaches, vcaches);
+
+    std::vector<IcarusGridHelper::dir> routes;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; i++) {
+      routes = routerHelper->computeRoutes(prefix, grid.getRows() / 2, grid.getColumns() / 2);
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    if (reference.empty()) {
+      reference = routes;
+    }
+    std::cout << algorithm << '\t' << elapsed.count() / iterations << '\t'
+              << (routes == reference ? "yes" : "no") << std::endl;
+  }
+}
+
 template <typename T>
 auto
 abs_diff(const T a, const T b) -> T
@@ -66,11 +116,24 @@ abs_diff(const T a, const T b) -> T
 auto
 main(int argc, char** argv)
 {
-  std::size_t rows = 10, columns = 10, clients = 1, cache_size = 10;
+  std::size_t rows = 10, columns = 10, clients = 1, cache_size = 10, objects = 1;
+  double zipf_alpha = 0.8;
+  std::size_t cache_bytes = 0, segment_size = 1024, object_size = 0;
+  double size_sigma = 1.0, segment_rate = 100.0;
+  bool coordinated = false;
   std::string routerHelperName = "Stochastic"s;
   std::string outPrefix = "results/"s;
   std::string hcaches_list, vcaches_list;
+  std::string hrate, hdelay, vrate, vdelay;
+  bool latitude_delay = false, link_cost = false;
+  bool lazy_trace = false;
+  std::string workload = "uniform"s;
+  ns3::Time crowd_start = Seconds(0.5), crowd_window = MilliSeconds(10);
   ns3::Time duration = Seconds(2.0);
+  ns3::Time checkpoint_interval = Seconds(0);
+  bool resume = false;
+  bool profile = false;
+  std::size_t route_benchmark = 0;
 
   // Setting default parameters for PointToPoint links and channels
   Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("1000Mbps"));
@@ -80,25 +143,114 @@ main(int argc, char** argv)
   CommandLine cmd;
   cmd.AddValue("rate", "ns3::PointToPointNetDevice::DataRate");
   cmd.AddValue("delay", "ns3::PointToPointChannel::Delay");
+  cmd.AddValue("hrate", "Data rate of the horizontal links (defaults to rate)", hrate);
+  cmd.AddValue("hdelay", "Delay of the horizontal links (defaults to delay)", hdelay);
+  cmd.AddValue("vrate", "Data rate of the vertical links (defaults to rate)", vrate);
+  cmd.AddValue("vdelay", "Delay of the vertical links (defaults to delay)", vdelay);
+  cmd.AddValue("latitudedelay", "Scale horizontal link delay with the latitude of each row",
+               latitude_delay);
+  cmd.AddValue("linkcost", "Break ties between axes by path cost (only useful with latitudedelay)",
+               link_cost);
   cmd.AddValue("duration", "Simulation duration", duration);
   cmd.AddValue("r", "Number of rows", rows);
   cmd.AddValue("c", "Number of columns", columns);
   cmd.AddValue("clients", "Number of clients", clients);
   cmd.AddValue("cache", "Cache size", cache_size);
+  cmd.AddValue("cachebytes", "Cache size in bytes (0 to use cache)", cache_bytes);
   cmd.AddValue("router", "Router helper algorithm", routerHelperName);
   cmd.AddValue("prefix", "Prefix for the output files", outPrefix);
   cmd.AddValue("hcaches", "Location of the horizontal caches", hcaches_list);
   cmd.AddValue("vcaches", "Location of the vertical caches", vcaches_list);
+  cmd.AddValue("objects", "Number of objects in the catalogue", objects);
+  cmd.AddValue("zipf", "Zipf exponent of the object popularity", zipf_alpha);
+  cmd.AddValue("segment", "Payload size of full Data packets", segment_size);
+  cmd.AddValue("objsize", "Median object size in bytes (0 for single segment objects)",
+               object_size);
+  cmd.AddValue("sizesigma", "Sigma of the log-normal object size distribution", size_sigma);
+  cmd.AddValue("segrate", "Interests per second when fetching segmented objects", segment_rate);
+  cmd.AddValue("coordinated", "Split the objects among the caches of each axis", coordinated);
+  cmd.AddValue("workload", "Client start pattern (uniform or flashcrowd)", workload);
+  cmd.AddValue("crowdstart", "Start of the flash crowd", crowd_start);
+  cmd.AddValue("crowdwindow", "Time span of the flash crowd arrivals", crowd_window);
+  cmd.AddValue("checkpoint", "Interval between checkpoints (0 disables them)",
+               checkpoint_interval);
+  cmd.AddValue("resume", "Resume from the last checkpoint", resume);
+  cmd.AddValue("profile", "Write a profile of the run to profile.json", profile);
+  cmd.AddValue("routebench", "Only time this many route computations of every router",
+               route_benchmark);
+  cmd.AddValue("lazytrace", "Only trace cache nodes and nodes on client routes", lazy_trace);
 
   cmd.Parse(argc, argv);
 
+  NS_ABORT_MSG_UNLESS(workload == "uniform" || workload == "flashcrowd",
+                      "Not a valid workload: " << workload);
+  NS_ABORT_MSG_UNLESS(objects > 0, "The catalogue cannot be empty.");
+  NS_ABORT_MSG_UNLESS(segment_size > 0, "Segments cannot be empty.");
+  const bool segmented = object_size > 0;
+
+  if (coordinated) {
+    routerHelperName = "CoordinatedLocations"s;
+  }
+
+  std::unique_ptr<IcarusProfiler> profiler;
+  if (profile) {
+    profiler = std::make_unique<IcarusProfiler>();
+    profiler->TraceSimulator();
+  }
+  const auto phase = [&profiler](const std::string& name) {
+    if (profiler) {
+      profiler->StartPhase(name);
+    }
+  };
+
   auto uniformRandomVar = CreateObject<UniformRandomVariable>();
 
   const auto hcaches = vec_from_string(hcaches_list);
   const auto vcaches = vec_from_string(vcaches_list);
 
-  PointToPointHelper p2p;
-  IcarusGridHelper grid(rows, columns, p2p);
+  phase("topology");
+
+  // Vertical links join satellites in the same orbital plane, horizontal links
+  // join neighbouring planes.
+  PointToPointHelper hp2p, vp2p;
+  if (!hrate.empty()) {
+    hp2p.SetDeviceAttribute("DataRate", StringValue(hrate));
+  }
+  if (!hdelay.empty()) {
+    hp2p.SetChannelAttribute("Delay", StringValue(hdelay));
+  }
+  if (!vrate.empty()) {
+    vp2p.SetDeviceAttribute("DataRate", StringValue(vrate));
+  }
+  if (!vdelay.empty()) {
+    vp2p.SetChannelAttribute("Delay", StringValue(vdelay));
+  }
+
+  IcarusGridHelper::RowDelay row_delay;
+  if (latitude_delay) {
+    // Planes get closer as they approach the poles. Rows are evenly spread
+    // along the orbit, with row 0 at the equator.
+    const Time equator_delay = hdelay.empty() ? default_link_delay() : Time(hdelay);
+    row_delay = [=](std::size_t row) {
+      const double latitude = 2 * M_PI * row / rows;
+      return equator_delay * std::max(std::abs(std::cos(latitude)), 0.1);
+    };
+  }
+
+  IcarusGridHelper grid(rows, columns, hp2p, vp2p, row_delay);
+
+  if (route_benchmark > 0) {
+    benchmark_routes(grid, hcaches, vcaches, route_benchmark);
+    return 0;
+  }
+
+  // Every object is named by a single component after the prefix
+  static const char prefix[] = "/icarus/static-grid/cache-test/1/";
+  const auto object_name = [](std::size_t object) {
+    return ndn::Name(prefix).appendSequenceNumber(object);
+  };
+
+  phase("stack");
 
   // Install NDN stack on all nodes
   ndn::StackHelper ndnHelper;
@@ -113,25 +265,53 @@ main(int argc, char** argv)
 
   for (std::size_t row = 0; row < rows; row++) {
     for (std::size_t column = 0; column < columns; column++) {
-      if ((abs_diff(row, producer_location_row) == 0
-           && find(hcaches.begin(), hcaches.end(), abs_diff(column, producer_location_column))
-                != hcaches.end())
-          || (abs_diff(column, producer_location_column) == 0
-              && find(vcaches.begin(), vcaches.end(), abs_diff(row, producer_location_row))
-                   != vcaches.end())) {
-        ndnHelper.setCsSize(cache_size);
+      const auto hcache =
+        find(hcaches.begin(), hcaches.end(), abs_diff(column, producer_location_column));
+      const auto vcache = find(vcaches.begin(), vcaches.end(), abs_diff(row, producer_location_row));
+      const bool is_hcache = abs_diff(row, producer_location_row) == 0 && hcache != hcaches.end();
+      const bool is_vcache =
+        abs_diff(column, producer_location_column) == 0 && vcache != vcaches.end();
+
+      if (is_hcache || is_vcache) {
+        // Byte capacity stores are only bounded by their policy
+        ndnHelper.setCsSize(cache_bytes > 0 ? std::numeric_limits<std::size_t>::max() : cache_size);
       }
       else {
         ndnHelper.setCsSize(0);
       }
 
-      ndnHelper.Install(grid.GetNode(row, column));
+      const auto node = grid.GetNode(row, column);
+      ndnHelper.Install(node);
+
+      if ((coordinated || cache_bytes > 0) && (is_hcache || is_vcache)) {
+        std::unique_ptr<nfd::cs::Policy> policy;
+        if (cache_bytes > 0) {
+          policy = std::make_unique<IcarusByteLruPolicy>(cache_bytes);
+        }
+        else {
+          policy = nfd::cs::Policy::create("lru");
+        }
+
+        if (coordinated) {
+          // The cache keeps the objects of its position along the axis
+          using Partition = std::pair<std::size_t, std::size_t>;
+          const auto [partition, partitions] =
+            is_hcache ? Partition(hcache - hcaches.begin(), hcaches.size())
+                      : Partition(vcache - vcaches.begin(), vcaches.size());
+          policy = std::make_unique<IcarusPartitionedPolicy>(
+            std::move(policy), ndn::Name(prefix).size(), partition, partitions);
+        }
+
+        node->GetObject<ndn::L3Protocol>()->getForwarder()->getCs().setPolicy(std::move(policy));
+      }
     }
   }
 
   // Set BestRoute strategy
   ndn::StrategyChoiceHelper::InstallAll("/", "/localhost/nfd/strategy/best-route");
 
+  phase("applications");
+
   // Getting containers for the consumer/producer
   Ptr<Node> producer =
     grid.GetNode(producer_location_row, producer_location_column); // At the center
@@ -143,42 +323,126 @@ main(int argc, char** argv)
     consumerNodes.Add(grid.GetNode(row, col));
   }
 
-  // Install NDN applications
-  static const char prefix[] = "/icarus/static-grid/cache-test/1/";
+  // A resumed simulation starts at the checkpoint time. Everything up to here
+  // must draw the same random values as in the checkpointed run.
+  IcarusCheckpointer checkpointer(grid, outPrefix + "checkpoint.bin");
+  const Time resume_time = resume ? checkpointer.Load() : Seconds(0);
 
+  // Install NDN applications
   ndn::AppHelper consumerHelper("ns3::ndn::ConsumerCbr");
   consumerHelper.SetPrefix(prefix);
-  consumerHelper.SetAttribute("Frequency", DoubleValue(1e-3));
+  consumerHelper.SetAttribute("Frequency", DoubleValue(segmented ? segment_rate : 1e-3));
   consumerHelper.SetAttribute("MaxSeq", IntegerValue(1));
   consumerHelper.SetAttribute("RetxTimer", TimeValue(Days(1)));
 
+  Ptr<ZipfRandomVariable> zipfRandomVar;
+  if (objects > 1) {
+    zipfRandomVar = CreateObject<ZipfRandomVariable>();
+    zipfRandomVar->SetAttribute("N", UintegerValue(objects));
+    zipfRandomVar->SetAttribute("Alpha", DoubleValue(zipf_alpha));
+  }
+
+  // Objects are split in as many segments as needed. The producer shortens
+  // the last one to the rest of the object.
+  std::vector<std::size_t> object_segments(objects, 1), object_bytes;
+  if (segmented) {
+    auto sizeRandomVar = CreateObject<LogNormalRandomVariable>();
+    sizeRandomVar->SetAttribute("Mu", DoubleValue(std::log(object_size)));
+    sizeRandomVar->SetAttribute("Sigma", DoubleValue(size_sigma));
+
+    for (auto& segments : object_segments) {
+      object_bytes.push_back(std::max<std::size_t>(1, std::llround(sizeRandomVar->GetValue())));
+      segments = (object_bytes.back() + segment_size - 1) / segment_size;
+    }
+  }
+
   // Have to install one by one to be able to set start time!
-  for (auto consumerNode = consumerNodes.Begin(); consumerNode != consumerNodes.End();
-       consumerNode++) {
-    auto appContainer = consumerHelper.Install(*consumerNode);
-    Time start_time = Seconds(uniformRandomVar->GetValue(0, duration.GetSeconds() - 0.5));
-    appContainer.Start(start_time);
+  std::vector<ndn::Name> consumerObjects;
+  for (std::size_t i = 0; i < consumerNodes.GetN(); i++) {
+    // With a single unsegmented object the consumer keeps asking for
+    // prefix/seq, that is, the first object.
+    const std::size_t object = objects > 1 ? zipfRandomVar->GetInteger() - 1 : 0;
+    consumerObjects.push_back(object_name(object));
+    if (objects > 1 || segmented) {
+      consumerHelper.SetPrefix(consumerObjects.back().toUri());
+      consumerHelper.SetAttribute("MaxSeq", IntegerValue(object_segments[object]));
+    }
+
+    // In a flash crowd every client asks for the object at almost the same time
+    Time start_time =
+      workload == "flashcrowd"
+        ? crowd_start + Seconds(uniformRandomVar->GetValue(0, crowd_window.GetSeconds()))
+        : Seconds(uniformRandomVar->GetValue(0, duration.GetSeconds() - 0.5));
+
+    const auto resumed_start = checkpointer.AddConsumer(start_time, object_segments[object]);
+    if (!resumed_start) { // Done before the checkpoint
+      continue;
+    }
+
+    auto appContainer = consumerHelper.Install(consumerNodes.Get(i));
+    appContainer.Start(*resumed_start);
+    checkpointer.TraceConsumer(i, appContainer.Get(0));
   }
 
-  ndn::AppHelper producerHelper("ns3::ndn::Producer");
+  ndn::AppHelper producerHelper("ns3::icarus::IcarusSizedProducer");
   producerHelper.SetPrefix(prefix);
-  producerHelper.SetAttribute("PayloadSize", UintegerValue(1024));
-  producerHelper.Install(producer);
+  producerHelper.SetAttribute("PayloadSize", UintegerValue(segment_size));
+  DynamicCast<IcarusSizedProducer>(producerHelper.Install(producer).Get(0))
+    ->SetObjectSizes(object_bytes, ndn::Name(prefix).size(), segment_size);
+
+  phase("routing");
 
   //  Calculate and install FIBs
   auto routerHelper = IcarusRouterGridHelper::CreateRouterHelper(routerHelperName, grid);
   routerHelper->addCacheLocations(hcaches, vcaches);
-  routerHelper->addRoute(prefix, rows / 2, columns / 2);
+  routerHelper->useLinkCost(link_cost);
+  if (coordinated) {
+    // Each object heads for the caches that own it
+    for (std::size_t object = 0; object < objects; object++) {
+      routerHelper->addRoute(object_name(object), rows / 2, columns / 2);
+    }
+  }
+  else {
+    routerHelper->addRoute(prefix, rows / 2, columns / 2);
+  }
+
+  phase("tracing");
 
   std::ofstream cs_trace_os(outPrefix + "cs-cache.txt", ios_base::trunc);
   IcarusGridTracer grid_tracer(grid, cs_trace_os, prefix);
-  grid_tracer.TraceGridCS();
-  grid_tracer.TraceGridTx();
+  grid_tracer.SetProfiler(profiler.get());
+  if (lazy_trace) {
+    grid_tracer.TraceCachesCS();
+    for (std::size_t i = 0; i < consumerNodes.GetN(); i++) {
+      grid_tracer.TraceRoute(consumerNodes.Get(i), consumerObjects[i]);
+    }
+  }
+  else {
+    grid_tracer.TraceGridCS();
+    grid_tracer.TraceGridPit();
+    grid_tracer.TraceGridTx();
+  }
+
+  checkpointer.AttachTracer(grid_tracer);
+  if (checkpoint_interval.IsStrictlyPositive()) {
+    checkpointer.Schedule(checkpoint_interval);
+  }
+
+  Simulator::Stop(duration - resume_time);
 
-  Simulator::Stop(duration);
+  phase("simulation");
 
   Simulator::Run();
 
+  grid_tracer.CollectCounters();
+  grid_tracer.CountAxisCaches(producer_location_row, producer_location_column);
+
+  if (profiler) {
+    profiler->EndPhase();
+    std::ofstream profile_os(outPrefix + "profile.json", ios_base::trunc);
+    profiler->Write(profile_os);
+  }
+
   Simulator::Destroy();
 
   return 0;